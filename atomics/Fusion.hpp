@@ -2,6 +2,7 @@
 #define BOOST_SIMULATION_FUSION_HPP
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <cadmium/modeling/ports.hpp>
 #include <cadmium/modeling/message_bag.hpp>
 #include <limits>
@@ -19,6 +20,10 @@
 
 #include "../drivers/Algorithm.h"
 
+#ifdef RT_ARM_MBED
+  #include "mbed.h"
+#endif
+
 
 using namespace cadmium;
 using namespace std;
@@ -38,19 +43,68 @@ struct Fusion_defs
   struct outT : public out_port<double> {};
 };
 
+// Fusion modes, from the most accurate to the cheapest. When the time taken
+// by a fusion exceeds the budget the model steps down one mode, and it steps
+// back up after a number of fusions that used at most half the budget. That
+// number starts at FUSION_RECOVER_COUNT and doubles, up to FUSION_RECOVER_MAX,
+// every time the first fusion after a step up overruns again, so a mode that
+// cannot meet the budget is retried less and less often.
+enum Fusion_mode {
+  FUSION_FULL,      // complete algorithm, principal components selected by the criterion
+  FUSION_REDUCED,   // single decomposition, first principal component only
+  FUSION_REUSE,     // weights of the last fusion that met the budget
+  FUSION_MEDIAN     // median of the readings
+};
+
+const int FUSION_RECOVER_COUNT = 8;
+const int FUSION_RECOVER_MAX = 4096;
+
+// On the board the deadline statistics are printed every FUSION_REPORT_COUNT
+// fusions and on every mode change.
+const unsigned long FUSION_REPORT_COUNT = 64;
+
+inline const char* fusion_mode_name(Fusion_mode mode) {
+  switch(mode) {
+    case FUSION_FULL: return "FULL";
+    case FUSION_REDUCED: return "REDUCED";
+    case FUSION_REUSE: return "REUSE";
+    default: return "MEDIAN";
+  }
+}
+
 template<typename TIME>
 class Fusion
 {
   using defs=Fusion_defs;
   	public:
-      Fusion() noexcept {
+      Fusion() noexcept : Fusion(0.9, 0) {}
+
+      // budget_us is the time allowed for one fusion in microseconds, 0 disables the deadline monitor.
+      // sensors is the number of connected ports from s1T on, only their readings are fused.
+      Fusion(double criterion, long budget_us, int sensors = 8) noexcept {
         for(int i=0;i<8;i++) {
           state.sT[i] = 0;
+          state.weight[i] = 0;
         }
         state.FusedT = 0;
         state.LastT = 0;
-        state.criterion = 0.9;
+        state.criterion = criterion;
+        state.sensors = std::min(std::max(sensors, 1), 8);
         state.active = false;
+        state.budget_us = budget_us;
+        state.mode = FUSION_FULL;
+        state.has_weight = false;
+        state.headroom = 0;
+        state.recover = FUSION_RECOVER_COUNT;
+        state.probing = false;
+        state.fusions = 0;
+        state.overruns = 0;
+        state.last_us = 0;
+        state.worst_us = 0;
+        for(int i=0;i<4;i++) {
+          state.mode_us[i] = 0;
+        }
+        state.reported_overruns = 0;
       }
 
       struct state_type {
@@ -58,7 +112,21 @@ class Fusion
         double FusedT;
         double LastT;
         double criterion;
+        int sensors;
         bool active;
+        long budget_us;
+        Fusion_mode mode;
+        double weight [8];
+        bool has_weight;
+        int headroom;
+        int recover;
+        bool probing;
+        unsigned long fusions;
+        unsigned long overruns;
+        long last_us;
+        long worst_us;
+        long mode_us [4];
+        unsigned long reported_overruns;
         }; state_type state;
 
         using input_ports=std::tuple<typename defs::s1T, typename defs::s2T, typename defs::s3T, typename defs::s4T, typename defs::s5T, typename defs::s6T, typename defs::s7T, typename defs::s8T>;
@@ -98,21 +166,33 @@ class Fusion
 
           state.FusedT = 0;
 
-         //Here goes the wrapper
-         
+          unsigned long started = now_us();
+          double weight [8];
+          Fusion_mode used = state.mode;
+          if(used == FUSION_REUSE && !state.has_weight) {
+            used = FUSION_MEDIAN;
+          }
 
-         state.FusedT = faulty_sensor_and_sensor_fusion(
-        		compute_integrated_support_degree_score(
-                    state.sT,
-        		    compute_alpha(eigen_value_calculation(
-                        sdm_calculator(state.sT,8),8),8),
+          switch(used) {
+            case FUSION_FULL:
+              state.FusedT = fuse_full(weight);
+              break;
+            case FUSION_REDUCED:
+              state.FusedT = fuse_reduced(weight);
+              break;
+            case FUSION_REUSE:
+              state.FusedT = weighted_fusion(state.weight, state.sT, state.sensors);
+              break;
+            case FUSION_MEDIAN:
+              state.FusedT = median_fusion(state.sT, state.sensors);
+              break;
+          }
 
-                    compute_phi(
-                        compute_alpha(
-                            eigen_value_calculation(
-                                sdm_calculator(
-				state.sT,8),
-				8),8),8), sdm_calculator(state.sT,8),state.criterion,8),state.sT,state.criterion,8);
+          //Unsigned subtraction stays correct when the ticker wraps around
+          state.last_us = (long) (now_us() - started);
+          if(state.budget_us > 0) {
+            check_deadline(used, weight);
+          }
 
           //If the values are not up to the mark, we can discard them here if that can be done.
       		state.active = true;
@@ -140,7 +220,93 @@ class Fusion
 
       friend std::ostringstream& operator<<(std::ostringstream& os, const typename Fusion<TIME>::state_type& i) {
                  os << "Sent Data by Fusion: " << i.FusedT ;
+                 if(i.budget_us > 0) {
+                   os << " Mode: " << fusion_mode_name(i.mode) << " Last(us): " << i.last_us << " Overruns: " << i.overruns << "/" << i.fusions;
+                 }
                  return os;
                }
+
+      private:
+        static unsigned long now_us() {
+          #ifdef RT_ARM_MBED
+            return us_ticker_read();
+          #else
+            return (unsigned long) std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+          #endif
+        }
+
+        // Complete algorithm on the current readings, the weights are returned for FUSION_REUSE.
+        double fuse_full(double weight[]) {
+          double* dmatrix = sdm_calculator(state.sT,state.sensors);
+          double* eval = eigen_value_calculation(dmatrix,state.sensors);
+          free(dmatrix);
+          double* alpha = compute_alpha(eval,state.sensors);
+          double* phi = compute_phi(alpha,state.sensors);
+          dmatrix = sdm_calculator(state.sT,state.sensors);
+          double* Z = compute_integrated_support_degree_score(state.sT,alpha,phi,dmatrix,state.criterion,state.sensors);
+          compute_weight_coefficients(Z,state.sT,state.criterion,state.sensors,weight);
+          free(dmatrix);
+          free(eval);
+          free(alpha);
+          free(phi);
+          free(Z);
+          return weighted_fusion(weight,state.sT,state.sensors);
+        }
+
+        // One decomposition instead of one per sensor and only the first principal component,
+        // a criterion of 0 selecting it. Faults are still found with the criterion.
+        double fuse_reduced(double weight[]) {
+          double Z [8];
+          compute_support_degree_scores(state.sT,0,state.sensors,Z);
+          compute_weight_coefficients(Z,state.sT,state.criterion,state.sensors,weight);
+          return weighted_fusion(weight,state.sT,state.sensors);
+        }
+
+        void check_deadline(Fusion_mode used, const double weight[]) {
+          Fusion_mode previous = state.mode;
+          state.fusions++;
+          state.worst_us = std::max(state.worst_us, state.last_us);
+          state.mode_us[used] = state.last_us;
+
+          if(state.last_us > state.budget_us) {
+            state.overruns++;
+            state.headroom = 0;
+            //The mode just stepped up to still overruns, wait longer before the next try
+            if(state.probing) {
+              state.recover = std::min(2 * state.recover, FUSION_RECOVER_MAX);
+            }
+            if(state.mode != FUSION_MEDIAN) {
+              state.mode = static_cast<Fusion_mode>(state.mode + 1);
+            }
+          } else {
+            if(state.probing) {
+              state.recover = FUSION_RECOVER_COUNT;
+            }
+            //Weights are only reused from a fusion that met the budget
+            if(used == FUSION_FULL || used == FUSION_REDUCED) {
+              std::copy(weight, weight + state.sensors, state.weight);
+              state.has_weight = true;
+            }
+            if(2 * state.last_us <= state.budget_us && state.mode != FUSION_FULL
+                && ++state.headroom >= state.recover) {
+              state.mode = static_cast<Fusion_mode>(state.mode - 1);
+              state.headroom = 0;
+            }
+          }
+          state.probing = state.mode < previous;
+
+          #ifdef RT_ARM_MBED
+            if(state.mode != previous || state.fusions % FUSION_REPORT_COUNT == 0) {
+              cout << "Fusion mode " << fusion_mode_name(previous) << " -> " << fusion_mode_name(state.mode)
+                   << " overruns: " << state.overruns << "/" << state.fusions
+                   << " new: " << state.overruns - state.reported_overruns
+                   << " last(us): " << state.last_us << " worst(us): " << state.worst_us
+                   << " full(us): " << state.mode_us[FUSION_FULL] << " reduced(us): " << state.mode_us[FUSION_REDUCED]
+                   << " budget(us): " << state.budget_us << endl;
+              state.reported_overruns = state.overruns;
+            }
+          #endif
+        }
       };
       #endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#ifndef BOOST_SIMULATION_FUSION_VECTOR_HPP
+#define BOOST_SIMULATION_FUSION_VECTOR_HPP
+
+#include <stdio.h>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <limits>
+#include <math.h>
+#include <assert.h>
+#include <memory>
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "../drivers/Algorithm.h"
+#include "../data_structures/channels.hpp"
+
+
+using namespace cadmium;
+using namespace std;
+
+
+// Same as Fusion, but every sensor sends FUSION_CHANNELS readings per message
+// and all the channels are fused in one pass by sensor_fusion_batch.
+struct FusionVector_defs
+{
+  struct s1T : public in_port<Channels_t>{};
+  struct s2T : public in_port<Channels_t>{};
+  struct s3T : public in_port<Channels_t>{};
+  struct s4T : public in_port<Channels_t>{};
+  struct s5T : public in_port<Channels_t>{};
+  struct s6T : public in_port<Channels_t>{};
+  struct s7T : public in_port<Channels_t>{};
+  struct s8T : public in_port<Channels_t>{};
+
+  struct outT : public out_port<Channels_t> {};
+};
+
+template<typename TIME>
+class FusionVector
+{
+  using defs=FusionVector_defs;
+  	public:
+      FusionVector() noexcept : FusionVector(0.9, false) {}
+
+      // share_faults removes a sensor faulty on one channel from every channel
+      FusionVector(double criterion, bool share_faults) noexcept {
+        for(int i=0;i<8*FUSION_CHANNELS;i++) {
+          state.sT[i] = 0;
+        }
+        state.criterion = criterion;
+        state.share_faults = share_faults;
+        state.active = false;
+      }
+
+      struct state_type {
+        // Channel after channel: reading of sensor i on channel c is sT[c*8+i]
+        double sT [8*FUSION_CHANNELS];
+        Channels_t FusedT;
+        Channels_t LastT;
+        double criterion;
+        bool share_faults;
+        bool active;
+        }; state_type state;
+
+        using input_ports=std::tuple<typename defs::s1T, typename defs::s2T, typename defs::s3T, typename defs::s4T, typename defs::s5T, typename defs::s6T, typename defs::s7T, typename defs::s8T>;
+      	using output_ports=std::tuple<typename defs::outT>;
+
+
+        void internal_transition (){
+          state.LastT = state.FusedT;
+          state.active = false;
+        }
+
+        void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs){
+          store(0, get_messages<typename defs::s1T>(mbs));
+          store(1, get_messages<typename defs::s2T>(mbs));
+          store(2, get_messages<typename defs::s3T>(mbs));
+          store(3, get_messages<typename defs::s4T>(mbs));
+          store(4, get_messages<typename defs::s5T>(mbs));
+          store(5, get_messages<typename defs::s6T>(mbs));
+          store(6, get_messages<typename defs::s7T>(mbs));
+          store(7, get_messages<typename defs::s8T>(mbs));
+
+          sensor_fusion_batch(state.sT, 8, FUSION_CHANNELS, state.criterion, state.share_faults, state.FusedT.ch);
+
+      		state.active = true;
+      	}
+
+        void confluence_transition(TIME e, typename make_message_bags<input_ports>::type mbs) {
+        internal_transition();
+        external_transition(TIME(), std::move(mbs));
+      }
+
+      typename make_message_bags<output_ports>::type output() const {
+        typename make_message_bags<output_ports>::type bags;
+          get_messages<typename defs::outT>(bags).push_back(state.FusedT);
+
+        return bags;
+      }
+
+      TIME time_advance() const {
+        if(state.active) {
+          return TIME("00:00:00");
+        }
+        return std::numeric_limits<TIME>::infinity();
+
+      }
+
+      friend std::ostringstream& operator<<(std::ostringstream& os, const typename FusionVector<TIME>::state_type& i) {
+                 os << "Sent Data by FusionVector: " << i.FusedT ;
+                 return os;
+               }
+
+      private:
+        template<typename BAG>
+        void store(int sensor, const BAG& messages) {
+          for(const auto &x : messages) {
+            for(int c=0;c<FUSION_CHANNELS;c++) {
+              state.sT[c*8+sensor] = x.ch[c];
+            }
+          }
+        }
+      };
+      #endif
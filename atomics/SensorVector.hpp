@@ -0,0 +1,32 @@
+#ifndef BOOST_SIMULATION_SENSOR_VECTOR_HPP
+#define BOOST_SIMULATION_SENSOR_VECTOR_HPP
+
+#include <stdio.h>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <limits>
+#include <string>
+
+#include "../data_structures/channels.hpp"
+
+
+using namespace cadmium;
+using namespace std;
+
+#include <cadmium/io/iestream.hpp>
+
+    //Port definition
+    struct SensorVector_defs{
+      struct out : public out_port<Channels_t> {};
+    };
+
+
+    template<typename TIME>
+    class SensorVector : public iestream_input<Channels_t,TIME, SensorVector_defs>{
+      public:
+        SensorVector() = default;
+        SensorVector(const char* file_path) : iestream_input<Channels_t,TIME, SensorVector_defs>(file_path) {}
+    };
+
+
+#endif
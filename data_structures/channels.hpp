@@ -0,0 +1,42 @@
+#ifndef BOOST_SIMULATION_CHANNELS_HPP
+#define BOOST_SIMULATION_CHANNELS_HPP
+
+#include <assert.h>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Number of quantities measured together by every sensor node,
+// e.g. temperature, humidity and pressure
+const int FUSION_CHANNELS = 3;
+
+/*******************************************/
+/**************** Channels_t ***************/
+/*******************************************/
+struct Channels_t{
+  Channels_t(){
+    for(int c=0;c<FUSION_CHANNELS;c++) {
+      ch[c] = 0;
+    }
+  }
+
+  double ch[FUSION_CHANNELS];
+};
+
+inline ostream& operator<<(ostream& os, const Channels_t& msg) {
+  for(int c=0;c<FUSION_CHANNELS;c++) {
+    os << (c ? " " : "") << msg.ch[c];
+  }
+  return os;
+}
+
+// Input files hold one time stamp followed by FUSION_CHANNELS values per line
+inline istream& operator>>(istream& is, Channels_t& msg) {
+  for(int c=0;c<FUSION_CHANNELS;c++) {
+    is >> msg.ch[c];
+  }
+  return is;
+}
+
+#endif
@@ -208,7 +208,7 @@ double* compute_integrated_support_degree_score(double sensorinputs[],
     gsl_matrix *y_temp =  gsl_matrix_alloc(size, size);
     gsl_matrix *y =  gsl_matrix_alloc(size, size);
     double *list_of_m_phi = (double *) malloc(sizeof(double)*(size));
-    double *evec_i = (double *) malloc(sizeof(double)*(size));
+    double *evec_i, *sdm;
     int i,j,k,l=0,rows,col,o,p,q,rows1=0,col1=0,rows2,col2;
     for(i=0;i<size;i++){
         list_of_m_phi[i]=list_of_phi[i];
@@ -226,7 +226,10 @@ double* compute_integrated_support_degree_score(double sensorinputs[],
     }
 
     for(o=0;o<size;o++){
-        evec_i = eigen_vector_calculation(sdm_calculator(sensorinputs,size),size,o);
+        //gsl destroys the matrix it decomposes, so a fresh copy is needed
+        sdm = sdm_calculator(sensorinputs,size);
+        evec_i = eigen_vector_calculation(sdm,size,o);
+        free(sdm);
         for(col=0;col<size;col++){
             for(rows=0;rows<size;rows++){
                 calculation = evec_i[col]* gsl_matrix_get(dmatrix2d,rows,col);
@@ -249,6 +252,7 @@ double* compute_integrated_support_degree_score(double sensorinputs[],
         gsl_matrix_set(y, rows1++, col1, temp);
         //printf("TEMP cols:%lf \n",temp);
         }
+        free(evec_i);
     }
 
     for(col=0;col<size;col++){
@@ -287,7 +291,6 @@ double* compute_integrated_support_degree_score(double sensorinputs[],
   gsl_matrix_free(dmatrix2d);
   gsl_matrix_free(Z_temp);
   free(list_of_m_phi);
-  free(evec_i);
   return Z;
 }
 
@@ -307,10 +310,35 @@ double* compute_integrated_support_degree_score(double sensorinputs[],
 double faulty_sensor_and_sensor_fusion(double Z[], double inputsensors[], double criterion,
 		int size){
 
-    int i, tempfault=0,j=0;
     double *weight = (double *) malloc(sizeof(double)*(size));
+    double fusion_value;
+
+    compute_weight_coefficients(Z, inputsensors, criterion, size, weight);
+    fusion_value = weighted_fusion(weight, inputsensors, size);
+    free(weight);
+    return fusion_value;
+}
+
+/** \brief Calculates the weight coefficient of every sensor after
+ *   eliminating erroneous readings.
+ *
+ * A sensor whose integrated support degree score is below the average
+ * score multiplied by the criterion is faulty and gets a weight of zero.
+ *
+ * @param[in,out] Z Array containing integrated support degree score of each
+ *  sensor at a specific timestamp. Scores of faulty sensors are set to zero.
+ * @param[in,out] inputsensors Readings of all sensors for a specific
+ *  timestamp. Readings of faulty sensors are set to zero.
+ * @param[in] criterion from the user multiplying to the average.
+ * @param[in] size The number of sensors being considered.
+ * @param[out] weight Weight coefficient of every sensor.
+ */
+void compute_weight_coefficients(double Z[], double inputsensors[], double criterion,
+		int size, double weight[]){
+
+    int i, tempfault=0,j=0;
     int *fault = (int *) malloc(sizeof(int)*(size));
-    double average, sum=0,calculation=0,fusion_value=0;
+    double average, sum=0,calculation=0;
 
     //Summation of integrated support degree score of all sensors
     for(i=0;i<size;i++){
@@ -354,13 +382,405 @@ double faulty_sensor_and_sensor_fusion(double Z[], double inputsensors[], double
   //  for(i=0;i<size;i++){
   //      printf("Weight coefficient : %lf\n",weight[i]);
   //  }
+    free(fault);
+}
+
+/** \brief Calculates the fused value from weight coefficients.
+ *
+ * @param[in] weight Weight coefficient of every sensor as produced by
+ *  compute_weight_coefficients, possibly at an earlier time stamp.
+ * @param[in] inputsensors Readings of all sensors for a specific timestamp.
+ * @param[in] size The number of sensors being considered.
+ *
+ * \return The summation of product of weight coefficient and sensor reading.
+ */
+double weighted_fusion(double weight[], double inputsensors[], int size){
+    int i;
+    double fusion_value=0;
 
     //Calculating the fused value as a summation of product of
     //weight coefficient and sensor reading
     for(i=0;i<size;i++){
         fusion_value += weight[i] * inputsensors[i];
     }
-    free(weight);
-    free(fault);
     return fusion_value;
 }
+
+/** \brief Calculates the median of the sensor readings.
+ *
+ * Cheap fallback that needs neither the support degree matrix nor any
+ * EigenValue. The readings are left untouched.
+ *
+ * @param[in] inputsensors Readings of all sensors for a specific timestamp.
+ * @param[in] size The number of sensors being considered.
+ *
+ * \return The median reading, the mean of the two middle ones for an even size.
+ */
+double median_fusion(double inputsensors[], int size){
+    int i, j;
+    double key, median;
+    double *sorted = (double *) malloc(sizeof(double)*(size));
+
+    //Insertion sort, size is the number of sensors of one fusion
+    for(i=0;i<size;i++){
+        key = inputsensors[i];
+        for(j=i-1;j>=0 && sorted[j]>key;j--){
+            sorted[j+1] = sorted[j];
+        }
+        sorted[j+1] = key;
+    }
+    if(size%2==1){
+        median = sorted[size/2];
+    }
+    else{
+        median = (sorted[size/2-1] + sorted[size/2])/2;
+    }
+    free(sorted);
+    return median;
+}
+
+/** \brief Runs every step of the algorithm for one time stamp.
+ *
+ * Chains sdm_calculator, eigen_value_calculation, compute_alpha,
+ * compute_phi, compute_integrated_support_degree_score and
+ * faulty_sensor_and_sensor_fusion, releasing every intermediate array so
+ * that the memory use stays constant no matter how many time stamps are
+ * fused.
+ *
+ * @param[in,out] sensorinputs Readings of all sensors for a specific
+ *  timestamp. Readings of faulty sensors are set to zero.
+ * @param[in] criterion The minimum value of accumulated contribution rate
+ *  between 0 and 1.
+ * @param[in] size The number of sensors being considered.
+ *
+ * \return The fused reading value after eliminating faulty sensor readings.
+ */
+double sensor_fusion(double sensorinputs[], double criterion, int size){
+    double *dmatrix, *eval_i, *list_of_alphas, *list_of_phi, *Z;
+    double fusion_value;
+
+    //eigen_value_calculation destroys the matrix, so it gets its own copy
+    dmatrix = sdm_calculator(sensorinputs, size);
+    eval_i = eigen_value_calculation(dmatrix, size);
+    free(dmatrix);
+
+    list_of_alphas = compute_alpha(eval_i, size);
+    list_of_phi = compute_phi(list_of_alphas, size);
+
+    dmatrix = sdm_calculator(sensorinputs, size);
+    Z = compute_integrated_support_degree_score(sensorinputs, list_of_alphas,
+            list_of_phi, dmatrix, criterion, size);
+    fusion_value = faulty_sensor_and_sensor_fusion(Z, sensorinputs, criterion, size);
+
+    free(dmatrix);
+    free(eval_i);
+    free(list_of_alphas);
+    free(list_of_phi);
+    free(Z);
+    return fusion_value;
+}
+
+/** \brief Calculates the Support Degree Matrices of several channels.
+ *
+ *  Same as sdm_calculator for every channel, the matrices are stored one
+ *  after the other in a single contiguous array so that the inner loop runs
+ *  over contiguous memory.
+ *
+ *  @param[in] sensorinputs Readings of all sensors, channel after channel:
+ *   the reading of sensor i on channel c is sensorinputs[c*size+i].
+ *  @param[in] size The number of sensors being considered.
+ *  @param[in] channels The number of channels of every sensor.
+ *  @param[out] dmatrices channels matrices of size*size elements.
+ */
+void sdm_calculator_batch(double sensorinputs[], int size, int channels, double dmatrices[]){
+    int c, i, j;
+    double *x, *row;
+
+    for(c=0;c<channels;c++){
+        x = sensorinputs + c*size;
+        for(i=0;i<size;i++){
+            row = dmatrices + ((size_t) c*size + i)*size;
+            for(j=0;j<size;j++){
+                row[j] = exp(-fabs(x[i]-x[j]));
+            }
+        }
+    }
+}
+
+/** Buffers shared by all the support degree score calculations of one call. */
+typedef struct {
+    double *scratch;
+    double *alpha;
+    double *columns;
+    gsl_vector *eval;
+    gsl_matrix *evec;
+    gsl_eigen_symmv_workspace *w;
+} score_workspace;
+
+static void score_workspace_alloc(score_workspace *ws, int size){
+    ws->scratch = (double *) malloc(sizeof(double)*size*size);
+    ws->alpha = (double *) malloc(sizeof(double)*size);
+    ws->columns = (double *) malloc(sizeof(double)*size*size);
+    ws->eval = gsl_vector_alloc(size);
+    ws->evec = gsl_matrix_alloc(size, size);
+    ws->w = gsl_eigen_symmv_alloc(size);
+}
+
+static void score_workspace_free(score_workspace *ws){
+    gsl_eigen_symmv_free(ws->w);
+    gsl_matrix_free(ws->evec);
+    gsl_vector_free(ws->eval);
+    free(ws->scratch);
+    free(ws->alpha);
+    free(ws->columns);
+}
+
+/** \brief Calculates the integrated support degree scores with a single
+ *   decomposition of the Support Degree Matrix.
+ *
+ *  Same scores as compute_integrated_support_degree_score, but the
+ *  EigenValues and EigenVectors come from one decomposition and only the
+ *  principal components selected by the criterion are computed.
+ *
+ *  @param[in] ws Buffers allocated for the size.
+ *  @param[in] dmatrix Support Degree Matrix, left untouched.
+ *  @param[in] criterion The minimum value of accumulated contribution rate.
+ *  @param[in] size The number of sensors.
+ *  @param[out] Z The integrated support degree score of every sensor.
+ */
+static void support_degree_scores(score_workspace *ws, double dmatrix[], double criterion,
+        int size, double Z[]){
+
+    int i, j, k, m;
+    double sum, calculation, dv;
+    double *row, *v;
+    gsl_matrix_view view;
+
+    //gsl destroys the matrix it decomposes
+    memcpy(ws->scratch, dmatrix, sizeof(double)*size*size);
+    view = gsl_matrix_view_array(ws->scratch, size, size);
+    gsl_eigen_symmv(&view.matrix, ws->eval, ws->evec, ws->w);
+    gsl_eigen_symmv_sort(ws->eval, ws->evec, GSL_EIGEN_SORT_ABS_DESC);
+
+    //Contribution rates and number of principal components m+1
+    sum = 0;
+    for(i=0;i<size;i++){
+        sum += gsl_vector_get(ws->eval, i);
+    }
+    calculation = 0;
+    m = size-1;
+    for(i=0;i<size;i++){
+        ws->alpha[i] = gsl_vector_get(ws->eval, i)/sum;
+        calculation += ws->alpha[i];
+        if(calculation>criterion && m==size-1){
+            m = i;
+        }
+    }
+
+    //Selected EigenVectors one after the other, so that the dot products
+    //below run over contiguous memory
+    for(k=0;k<=m;k++){
+        for(j=0;j<size;j++){
+            ws->columns[(size_t) k*size+j] = ws->evec->data[(size_t) j*ws->evec->tda+k];
+        }
+    }
+
+    //Integrated support degree score of every sensor
+    for(i=0;i<size;i++){
+        Z[i] = 0;
+    }
+    for(k=0;k<=m;k++){
+        v = ws->columns + (size_t) k*size;
+        for(i=0;i<size;i++){
+            row = dmatrix + (size_t) i*size;
+            dv = 0;
+            for(j=0;j<size;j++){
+                dv += row[j]*v[j];
+            }
+            Z[i] += ws->alpha[k]*dv;
+        }
+    }
+}
+
+/** \brief Calculates the integrated support degree score of all sensors
+ *   with a single decomposition.
+ *
+ *  Cheaper replacement for the chain from sdm_calculator to
+ *  compute_integrated_support_degree_score, which decomposes the Support
+ *  Degree Matrix once per sensor. Only the principal components selected
+ *  by the criterion are computed, so a criterion of 0 computes only the
+ *  first one.
+ *
+ *  @param[in] sensorinputs Readings of all sensors at a specific timestamp.
+ *  @param[in] criterion The minimum value of accumulated contribution rate
+ *   between 0 and 1.
+ *  @param[in] size The number of sensors.
+ *  @param[out] Z The integrated support degree score of every sensor.
+ */
+void compute_support_degree_scores(double sensorinputs[], double criterion, int size, double Z[]){
+    score_workspace ws;
+    double *dmatrix = sdm_calculator(sensorinputs, size);
+
+    score_workspace_alloc(&ws, size);
+    support_degree_scores(&ws, dmatrix, criterion, size, Z);
+    score_workspace_free(&ws);
+    free(dmatrix);
+}
+
+/** Buffers of sensor_fusion_batch, allocated once for a number of sensors
+ *  and channels and reused for every time stamp. */
+struct fusion_workspace {
+    int size;
+    int channels;
+    double *dmatrices;
+    double *Z;
+    int *fault;
+    score_workspace scores;
+};
+
+/** \brief Allocates the buffers of sensor_fusion_workspace.
+ *
+ *  @param[in] size The number of sensors being considered.
+ *  @param[in] channels The number of channels of every sensor.
+ *
+ *  \return The workspace, to be released with fusion_workspace_free.
+ */
+fusion_workspace* fusion_workspace_alloc(int size, int channels){
+    fusion_workspace *fw = (fusion_workspace *) malloc(sizeof(fusion_workspace));
+
+    fw->size = size;
+    fw->channels = channels;
+    fw->dmatrices = (double *) malloc(sizeof(double)*size*size*channels);
+    fw->Z = (double *) malloc(sizeof(double)*size*channels);
+    fw->fault = (int *) malloc(sizeof(int)*size*channels);
+    score_workspace_alloc(&fw->scores, size);
+    return fw;
+}
+
+/** \brief Releases the buffers allocated by fusion_workspace_alloc.
+ *
+ *  @param[in] fw The workspace, may be NULL.
+ */
+void fusion_workspace_free(fusion_workspace *fw){
+    if(fw==NULL){
+        return;
+    }
+    score_workspace_free(&fw->scores);
+    free(fw->dmatrices);
+    free(fw->Z);
+    free(fw->fault);
+    free(fw);
+}
+
+/** \brief Runs every step of the algorithm on several channels at once,
+ *   without allocating any memory.
+ *
+ *  Every channel is fused as sensor_fusion would, but each Support Degree
+ *  Matrix is decomposed only once for both its EigenValues and its
+ *  EigenVectors, and every intermediate array comes from the workspace so
+ *  that fusing many time stamps allocates nothing.
+ *
+ *  @param[in] fw Workspace allocated for the number of sensors and channels.
+ *  @param[in] sensorinputs Readings of all sensors, channel after channel:
+ *   the reading of sensor i on channel c is sensorinputs[c*size+i]. The
+ *   readings are not modified.
+ *  @param[in] criterion The minimum value of accumulated contribution rate
+ *   between 0 and 1, also multiplying the average score to find faults.
+ *  @param[in] share_faults When not zero, a sensor faulty on one channel is
+ *   removed from every channel, unless that would remove every sensor.
+ *  @param[out] fused The fused value of every channel.
+ */
+void sensor_fusion_workspace(fusion_workspace *fw, double sensorinputs[], double criterion,
+        int share_faults, double fused[]){
+
+    int c, i, remaining, healthy;
+    int size = fw->size, channels = fw->channels;
+    size_t n2 = (size_t) size*size;
+    double sum, average, calculation, fusion_value;
+    double *Z = fw->Z;
+    int *fault = fw->fault;
+    double *x, *z;
+
+    sdm_calculator_batch(sensorinputs, size, channels, fw->dmatrices);
+
+    for(c=0;c<channels;c++){
+        z = Z + c*size;
+        support_degree_scores(&fw->scores, fw->dmatrices + n2*c, criterion, size, z);
+
+        //Faulty sensors of this channel
+        sum = 0;
+        for(i=0;i<size;i++){
+            sum += z[i];
+        }
+        average = fabs((sum/size))*criterion;
+        for(i=0;i<size;i++){
+            fault[c*size+i] = fabs(z[i])<average;
+        }
+    }
+
+    //The shared faults are only used if they leave at least one sensor,
+    //otherwise every channel keeps its own faults
+    if(share_faults){
+        remaining = 0;
+        for(i=0;i<size;i++){
+            healthy = 1;
+            for(c=0;c<channels;c++){
+                if(fault[c*size+i]){
+                    healthy = 0;
+                }
+            }
+            remaining += healthy;
+        }
+        for(i=0;i<size && remaining>0;i++){
+            for(c=1;c<channels;c++){
+                fault[i] |= fault[c*size+i];
+            }
+            for(c=1;c<channels;c++){
+                fault[c*size+i] = fault[i];
+            }
+        }
+    }
+
+    //Weight coefficients and fused value of every channel
+    for(c=0;c<channels;c++){
+        z = Z + c*size;
+        x = sensorinputs + c*size;
+        calculation = 0;
+        for(i=0;i<size;i++){
+            if(fault[c*size+i]){
+                z[i] = 0;
+            }
+            calculation += z[i];
+        }
+        fusion_value = 0;
+        for(i=0;i<size;i++){
+            fusion_value += z[i]/calculation * x[i];
+        }
+        fused[c] = fusion_value;
+    }
+}
+
+/** \brief Runs every step of the algorithm on several channels at once.
+ *
+ *  Same as sensor_fusion_workspace with a workspace allocated for this
+ *  call only. Callers fusing many time stamps of the same sensors should
+ *  allocate the workspace once and call sensor_fusion_workspace instead.
+ *
+ *  @param[in] sensorinputs Readings of all sensors, channel after channel:
+ *   the reading of sensor i on channel c is sensorinputs[c*size+i]. The
+ *   readings are not modified.
+ *  @param[in] size The number of sensors being considered.
+ *  @param[in] channels The number of channels of every sensor.
+ *  @param[in] criterion The minimum value of accumulated contribution rate
+ *   between 0 and 1, also multiplying the average score to find faults.
+ *  @param[in] share_faults When not zero, a sensor faulty on one channel is
+ *   removed from every channel, unless that would remove every sensor.
+ *  @param[out] fused The fused value of every channel.
+ */
+void sensor_fusion_batch(double sensorinputs[], int size, int channels, double criterion,
+        int share_faults, double fused[]){
+
+    fusion_workspace *fw = fusion_workspace_alloc(size, channels);
+    sensor_fusion_workspace(fw, sensorinputs, criterion, share_faults, fused);
+    fusion_workspace_free(fw);
+}
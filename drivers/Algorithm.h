@@ -59,6 +59,70 @@ double* compute_integrated_support_degree_score(double[], double[], double[], do
  */
 double faulty_sensor_and_sensor_fusion(double[],double[],double, int);
 
+/**
+ * Calculates the weight coefficient of every sensor after identifying
+ * and removing faulty sensor values.
+ */
+void compute_weight_coefficients(double[], double[], double, int, double[]);
+
+/**
+ * Calculates the fused value from the weight coefficients of the sensors.
+ */
+double weighted_fusion(double[], double[], int);
+
+/**
+ * Calculates the median of the sensor readings, used when there is no
+ * time for the complete algorithm.
+ */
+double median_fusion(double[], int);
+
+/**
+ * Runs all the steps above for one time stamp and frees every
+ * intermediate result before returning the fused value.
+ */
+double sensor_fusion(double[], double, int);
+
+/**
+ * Calculates the integrated support degree score of each sensor with a
+ * single decomposition, computing only the principal components selected
+ * by the criterion.
+ */
+void compute_support_degree_scores(double[], double, int, double[]);
+
+/**
+ * Calculates the Support Degree Matrices of several channels, stored
+ * one after the other in a contiguous array.
+ */
+void sdm_calculator_batch(double[], int, int, double[]);
+
+/**
+ * Buffers of a batched fusion, reused from one time stamp to the next.
+ */
+typedef struct fusion_workspace fusion_workspace;
+
+/**
+ * Allocates the buffers of a batched fusion for the given number of
+ * sensors and channels.
+ */
+fusion_workspace* fusion_workspace_alloc(int, int);
+
+/**
+ * Frees the buffers of a batched fusion.
+ */
+void fusion_workspace_free(fusion_workspace*);
+
+/**
+ * Same as sensor_fusion_batch with the buffers of a workspace, so that
+ * fusing many time stamps does not allocate any memory.
+ */
+void sensor_fusion_workspace(fusion_workspace*, double[], double, int, double[]);
+
+/**
+ * Fuses several channels of the same sensors in one pass, optionally
+ * removing a sensor faulty on one channel from every channel.
+ */
+void sensor_fusion_batch(double[], int, int, double, int, double[]);
+
 }
 
 
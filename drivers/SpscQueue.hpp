@@ -0,0 +1,58 @@
+/** \file SpscQueue.hpp
+ *
+ *  Lock-free bounded queue between exactly one producer thread and one
+ *  consumer thread. Used on the host only.
+ */
+
+#ifndef SpscQueue_hpp
+#define SpscQueue_hpp
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Ring buffer of CAPACITY - 1 elements, CAPACITY must be a power of two.
+ * push and pop never block: they return false when the queue is full or
+ * empty. The head and tail indexes live on separate cache lines so the
+ * producer and the consumer do not invalidate each other's line.
+ */
+template<typename T, std::size_t CAPACITY>
+class spsc_queue {
+  static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+  public:
+    spsc_queue() : head(0), tail(0) {}
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    // Producer side
+    bool push(const T& item) {
+      const std::size_t t = tail.load(std::memory_order_relaxed);
+      const std::size_t next = (t + 1) & (CAPACITY - 1);
+      if(next == head.load(std::memory_order_acquire)) {
+        return false;
+      }
+      items[t] = item;
+      tail.store(next, std::memory_order_release);
+      return true;
+    }
+
+    // Consumer side
+    bool pop(T& item) {
+      const std::size_t h = head.load(std::memory_order_relaxed);
+      if(h == tail.load(std::memory_order_acquire)) {
+        return false;
+      }
+      item = items[h];
+      head.store((h + 1) & (CAPACITY - 1), std::memory_order_release);
+      return true;
+    }
+
+  private:
+    alignas(64) std::atomic<std::size_t> head;
+    alignas(64) std::atomic<std::size_t> tail;
+    alignas(64) T items[CAPACITY];
+};
+
+#endif /* SpscQueue_hpp */
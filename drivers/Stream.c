@@ -0,0 +1,391 @@
+/** \file Stream.c
+ *  Contains functions to reprocess sensor archives that are larger than
+ *  the available memory.
+ *
+ *  Every sensor file is read sequentially in fixed-size blocks, the files
+ *  are merged on their time stamps into batches of rows and the fused
+ *  values of every group of sensors are written to a columnar file. The
+ *  memory used is bounded by the block size, the number of sensors and the
+ *  batch size and does not depend on the length of the archive.
+ *
+ *  The columnar file starts with the 8 byte magic "SFCOL1\n" followed by
+ *  the number of sensors and the number of fused columns as 32 bit
+ *  integers. It is followed by one row group per batch: the number of rows
+ *  as a 32 bit integer, the time stamps in milliseconds as 64 bit integers
+ *  and then every fused column as doubles, one column after the other.
+ *  All numbers are stored in the byte order of the host.
+ */
+
+#include "Stream.h"
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char stream_magic[8] = {'S','F','C','O','L','1','\n','\0'};
+
+struct stream_reader {
+    FILE *fp;
+    char *block;
+    size_t capacity;
+    size_t start;
+    size_t end;
+    int eof;
+};
+
+struct stream_aligner {
+    int count;
+    long long tick;
+    stream_reader **readers;
+    long long *next_time;
+    double *next_value;
+    int *pending;
+    double *latest;
+};
+
+struct stream_writer {
+    FILE *fp;
+    int columns;
+    int ok;
+};
+
+/** \brief Parses a time stamp at the start of a string.
+ *
+ *  @param[in] text The string starting with the time stamp.
+ *  @param[out] rest Position of the first character after the time stamp.
+ *  @param[out] ms The time stamp in milliseconds.
+ *
+ *  \return 1 if a time stamp with 3 or 4 fields was found and 0 otherwise.
+ */
+static int parse_time(const char *text, const char **rest, long long *ms){
+    long long fields[4];
+    int n = 0;
+    const char *p = text;
+    char *end;
+
+    while(isspace((unsigned char) *p)){
+        p++;
+    }
+    for(;;){
+        if(!isdigit((unsigned char) *p)){
+            return 0;
+        }
+        fields[n++] = strtoll(p, &end, 10);
+        p = end;
+        if(*p != ':' || n == 4){
+            break;
+        }
+        p++;
+    }
+    if(n < 3){
+        return 0;
+    }
+    *ms = fields[0]*3600000LL + fields[1]*60000LL + fields[2]*1000LL;
+    if(n == 4){
+        *ms += fields[3];
+    }
+    *rest = p;
+    return 1;
+}
+
+/** \brief Converts a time stamp into milliseconds.
+ *
+ *  @param[in] text Time stamp in the hh:mm:ss or hh:mm:ss:mss format. The
+ *   hours are not limited to two digits.
+ *  @param[out] ms The time stamp in milliseconds.
+ *
+ *  \return 1 on success and 0 if the text is not a time stamp.
+ */
+int stream_parse_time(const char *text, long long *ms){
+    const char *rest;
+    return parse_time(text, &rest, ms);
+}
+
+/** \brief Opens a sensor file for block-wise sequential reading.
+ *
+ *  @param[in] path Path of the sensor file.
+ *  @param[in] block_size Number of bytes read from the file at once.
+ *
+ *  \return The reader or NULL if the file cannot be opened.
+ */
+stream_reader* stream_reader_open(const char *path, size_t block_size){
+    stream_reader *r;
+    FILE *fp = fopen(path, "rb");
+
+    if(fp == NULL){
+        return NULL;
+    }
+    //The block buffer replaces the one of stdio
+    setvbuf(fp, NULL, _IONBF, 0);
+
+    r = (stream_reader *) malloc(sizeof(stream_reader));
+    r->fp = fp;
+    r->capacity = block_size > 0 ? block_size : 1;
+    r->block = (char *) malloc(r->capacity + 1);
+    r->start = 0;
+    r->end = 0;
+    r->eof = 0;
+    return r;
+}
+
+/** \brief Reads the next sample of a sensor file.
+ *
+ *  Lines that do not start with a time stamp followed by a value, such as
+ *  empty lines, are skipped. A line longer than the block grows the block.
+ *
+ *  @param[in] r The reader.
+ *  @param[out] ms Time stamp of the sample in milliseconds.
+ *  @param[out] value Reading of the sample.
+ *
+ *  \return 1 if a sample was read and 0 at the end of the file.
+ */
+int stream_reader_next(stream_reader *r, long long *ms, double *value){
+    char *line, *nl, *end;
+    const char *rest;
+    size_t n;
+
+    for(;;){
+        nl = (char *) memchr(r->block + r->start, '\n', r->end - r->start);
+
+        if(nl == NULL && !r->eof){
+            //Move the partial line to the front and read the next block
+            memmove(r->block, r->block + r->start, r->end - r->start);
+            r->end -= r->start;
+            r->start = 0;
+            if(r->end == r->capacity){
+                r->capacity *= 2;
+                r->block = (char *) realloc(r->block, r->capacity + 1);
+            }
+            n = fread(r->block + r->end, 1, r->capacity - r->end, r->fp);
+            r->end += n;
+            if(n == 0){
+                r->eof = 1;
+            }
+            continue;
+        }
+
+        if(nl == NULL){
+            if(r->start == r->end){
+                return 0;
+            }
+            //Last line of the file without a line break
+            nl = r->block + r->end;
+        }
+
+        line = r->block + r->start;
+        *nl = '\0';
+        r->start = (size_t) (nl - r->block);
+        if(r->start < r->end){
+            r->start++;
+        }
+
+        if(parse_time(line, &rest, ms)){
+            *value = strtod(rest, &end);
+            if(end != rest){
+                return 1;
+            }
+        }
+    }
+}
+
+/** \brief Closes a sensor file.
+ *
+ *  @param[in] r The reader, may be NULL.
+ */
+void stream_reader_close(stream_reader *r){
+    if(r == NULL){
+        return;
+    }
+    fclose(r->fp);
+    free(r->block);
+    free(r);
+}
+
+/** \brief Opens all sensor files of an archive.
+ *
+ *  The first sample of every file is read ahead so that the files can be
+ *  merged on their time stamps. Until a sensor sends its first sample its
+ *  reading is zero, as in the Fusion model.
+ *
+ *  @param[in] paths Paths of the sensor files.
+ *  @param[in] count Number of sensor files.
+ *  @param[in] block_size Number of bytes read from each file at once.
+ *  @param[in] tick_ms Width in milliseconds of the time slots samples are
+ *   aligned on, 0 to align only samples with exactly the same time stamp.
+ *
+ *  \return The aligner or NULL if any file cannot be opened.
+ */
+stream_aligner* stream_aligner_open(const char* const paths[], int count, size_t block_size,
+        long long tick_ms){
+    int i;
+    stream_aligner *a = (stream_aligner *) malloc(sizeof(stream_aligner));
+
+    a->count = count;
+    a->tick = tick_ms > 0 ? tick_ms : 0;
+    a->readers = (stream_reader **) calloc(count, sizeof(stream_reader *));
+    a->next_time = (long long *) malloc(sizeof(long long)*count);
+    a->next_value = (double *) malloc(sizeof(double)*count);
+    a->pending = (int *) malloc(sizeof(int)*count);
+    a->latest = (double *) calloc(count, sizeof(double));
+
+    for(i=0;i<count;i++){
+        a->readers[i] = stream_reader_open(paths[i], block_size);
+        if(a->readers[i] == NULL){
+            stream_aligner_close(a);
+            return NULL;
+        }
+        a->pending[i] = stream_reader_next(a->readers[i], &a->next_time[i], &a->next_value[i]);
+    }
+    return a;
+}
+
+/** \brief Fills a batch of rows aligned on time stamps.
+ *
+ *  Every row holds the latest reading of every sensor at one time stamp
+ *  where at least one sensor has a sample, which is the state the Fusion
+ *  model fuses when it receives messages. With a tick, every row instead
+ *  covers one time slot of tick milliseconds holding at least one sample
+ *  and is stamped with the start of the slot, so sensors whose time stamps
+ *  jitter by less than a tick give one row per slot instead of one each.
+ *
+ *  @param[in] a The aligner.
+ *  @param[out] timestamps Time stamp of every row in milliseconds.
+ *  @param[out] values Readings of every row, count values per row.
+ *  @param[in] capacity Maximum number of rows.
+ *
+ *  \return Number of rows filled, 0 once all sensor files are read.
+ */
+int stream_aligner_fill(stream_aligner *a, long long timestamps[], double values[], int capacity){
+    int i, rows = 0, found;
+    long long t, limit;
+
+    while(rows < capacity){
+        found = 0;
+        t = 0;
+        for(i=0;i<a->count;i++){
+            if(a->pending[i] && (!found || a->next_time[i] < t)){
+                t = a->next_time[i];
+                found = 1;
+            }
+        }
+        if(!found){
+            break;
+        }
+        limit = t + 1;
+        if(a->tick > 0){
+            t -= ((t % a->tick) + a->tick) % a->tick;
+            limit = t + a->tick;
+        }
+
+        //The last sample of a sensor in the same slot wins
+        for(i=0;i<a->count;i++){
+            while(a->pending[i] && a->next_time[i] < limit){
+                a->latest[i] = a->next_value[i];
+                a->pending[i] = stream_reader_next(a->readers[i], &a->next_time[i], &a->next_value[i]);
+            }
+        }
+
+        timestamps[rows] = t;
+        memcpy(values + (size_t) rows*a->count, a->latest, sizeof(double)*a->count);
+        rows++;
+    }
+    return rows;
+}
+
+/** \brief Closes all sensor files of an archive.
+ *
+ *  @param[in] a The aligner, may be NULL.
+ */
+void stream_aligner_close(stream_aligner *a){
+    int i;
+
+    if(a == NULL){
+        return;
+    }
+    for(i=0;i<a->count;i++){
+        stream_reader_close(a->readers[i]);
+    }
+    free(a->readers);
+    free(a->next_time);
+    free(a->next_value);
+    free(a->pending);
+    free(a->latest);
+    free(a);
+}
+
+/** \brief Creates a columnar output file.
+ *
+ *  @param[in] path Path of the output file.
+ *  @param[in] sensors Number of sensors of the archive.
+ *  @param[in] columns Number of fused values of every row.
+ *
+ *  \return The writer or NULL if the file cannot be created.
+ */
+stream_writer* stream_writer_open(const char *path, int sensors, int columns){
+    stream_writer *w;
+    int32_t count = sensors, fused = columns;
+    FILE *fp = fopen(path, "wb");
+
+    if(fp == NULL){
+        return NULL;
+    }
+    w = (stream_writer *) malloc(sizeof(stream_writer));
+    w->fp = fp;
+    w->columns = columns;
+    w->ok = fwrite(stream_magic, sizeof(stream_magic), 1, fp) == 1
+            && fwrite(&count, sizeof(count), 1, fp) == 1
+            && fwrite(&fused, sizeof(fused), 1, fp) == 1;
+    return w;
+}
+
+/** \brief Appends a row group to a columnar output file.
+ *
+ *  @param[in] w The writer.
+ *  @param[in] timestamps Time stamps of the rows in milliseconds.
+ *  @param[in] fused Fused values, column after column: the value of
+ *   column c at row r is fused[c*rows+r].
+ *  @param[in] rows Number of rows.
+ *
+ *  \return 1 on success and 0 if any write failed so far.
+ */
+int stream_writer_append(stream_writer *w, const long long timestamps[], const double fused[], int rows){
+    int i;
+    int32_t count = rows;
+    int64_t t;
+    size_t n;
+
+    if(!w->ok || rows <= 0){
+        return w->ok;
+    }
+    w->ok = fwrite(&count, sizeof(count), 1, w->fp) == 1;
+    for(i=0;i<rows && w->ok;i++){
+        t = timestamps[i];
+        w->ok = fwrite(&t, sizeof(t), 1, w->fp) == 1;
+    }
+    if(w->ok){
+        n = (size_t) rows*w->columns;
+        w->ok = fwrite(fused, sizeof(double), n, w->fp) == n;
+    }
+    return w->ok;
+}
+
+/** \brief Flushes and closes a columnar output file.
+ *
+ *  @param[in] w The writer, may be NULL.
+ *
+ *  \return 1 on success and 0 if any write failed.
+ */
+int stream_writer_close(stream_writer *w){
+    int ok;
+
+    if(w == NULL){
+        return 0;
+    }
+    ok = w->ok && fclose(w->fp) == 0;
+    if(!w->ok){
+        fclose(w->fp);
+    }
+    free(w);
+    return ok;
+}
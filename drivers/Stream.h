@@ -0,0 +1,93 @@
+/** \file Stream.h
+ *
+ *  Contains the declarations of functions used in Stream.c file to
+ *  reprocess sensor archives that do not fit in memory.
+ */
+
+#ifndef Stream_h
+#define Stream_h
+
+#include <stdio.h>
+#include <stddef.h>
+
+extern "C" {
+
+/**
+ * Reads one sensor file sequentially in fixed-size blocks.
+ */
+typedef struct stream_reader stream_reader;
+
+/**
+ * Merges several sensor files on their time stamps.
+ */
+typedef struct stream_aligner stream_aligner;
+
+/**
+ * Writes fused values to a columnar file.
+ */
+typedef struct stream_writer stream_writer;
+
+/**
+ * Converts a time stamp in the hh:mm:ss or hh:mm:ss:mss format used by the
+ * input files into milliseconds. Returns 1 on success and 0 otherwise.
+ */
+int stream_parse_time(const char*, long long*);
+
+/**
+ * Opens a sensor file for reading in blocks of the given number of bytes.
+ * Returns NULL if the file cannot be opened.
+ */
+stream_reader* stream_reader_open(const char*, size_t);
+
+/**
+ * Reads the next time stamp and value of a sensor file.
+ * Returns 1 on success and 0 at the end of the file.
+ */
+int stream_reader_next(stream_reader*, long long*, double*);
+
+/**
+ * Closes a sensor file and frees its block buffer.
+ */
+void stream_reader_close(stream_reader*);
+
+/**
+ * Opens every sensor file of an archive for time stamp aligned reading,
+ * optionally aligning the samples on time slots of a tick in milliseconds.
+ * Returns NULL if any of the files cannot be opened.
+ */
+stream_aligner* stream_aligner_open(const char* const[], int, size_t, long long);
+
+/**
+ * Fills a batch of aligned rows, one row per distinct time stamp or time
+ * slot, and returns the number of rows written. Returns 0 once all files
+ * are read.
+ */
+int stream_aligner_fill(stream_aligner*, long long[], double[], int);
+
+/**
+ * Closes every sensor file of an archive.
+ */
+void stream_aligner_close(stream_aligner*);
+
+/**
+ * Creates a columnar output file for the given number of sensors and
+ * fused columns. Returns NULL if the file cannot be created.
+ */
+stream_writer* stream_writer_open(const char*, int, int);
+
+/**
+ * Appends one row group of time stamps and fused columns.
+ * Returns 1 on success and 0 on a write error.
+ */
+int stream_writer_append(stream_writer*, const long long[], const double[], int);
+
+/**
+ * Flushes and closes a columnar output file.
+ * Returns 1 on success and 0 on a write error.
+ */
+int stream_writer_close(stream_writer*);
+
+}
+
+
+#endif /* Stream_h */
@@ -0,0 +1,66 @@
+// Benchmark of the batching of the multi-channel fusion: one single-channel
+// sensor_fusion_batch call per channel against one call fusing all
+// FUSION_CHANNELS channels, as the FusionVector model runs it. Both sides run
+// the same single decomposition algorithm, only the batching differs.
+#ifndef RT_ARM_MBED
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+#include "../drivers/Algorithm.h"
+#include "../data_structures/channels.hpp"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+
+const int SENSORS = 8;
+
+int main(int argc, char ** argv) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 100000;
+  double criterion = 0.9;
+
+  // Readings around 20 with an occasional faulty sensor, channel after channel
+  mt19937 gen(1);
+  normal_distribution<double> noise(20.0, 0.5);
+  uniform_int_distribution<int> faulty(0, 9);
+  vector<double> readings((size_t) iterations * SENSORS * FUSION_CHANNELS);
+  for(auto &x : readings) {
+    x = noise(gen) + (faulty(gen) == 0 ? 15.0 : 0.0);
+  }
+
+  vector<double> separate((size_t) iterations * FUSION_CHANNELS), batched(separate.size());
+
+  auto start = hclock::now();
+  for(int it = 0; it < iterations; it++) {
+    double* row = &readings[(size_t) it * SENSORS * FUSION_CHANNELS];
+    for(int c = 0; c < FUSION_CHANNELS; c++) {
+      sensor_fusion_batch(row + c * SENSORS, SENSORS, 1, criterion, 0, &separate[(size_t) it * FUSION_CHANNELS + c]);
+    }
+  }
+  double separate_s = chrono::duration<double>(hclock::now() - start).count();
+
+  start = hclock::now();
+  for(int it = 0; it < iterations; it++) {
+    sensor_fusion_batch(&readings[(size_t) it * SENSORS * FUSION_CHANNELS], SENSORS, FUSION_CHANNELS,
+                        criterion, 0, &batched[(size_t) it * FUSION_CHANNELS]);
+  }
+  double batched_s = chrono::duration<double>(hclock::now() - start).count();
+
+  double max_diff = 0;
+  for(size_t k = 0; k < separate.size(); k++) {
+    max_diff = fmax(max_diff, fabs(separate[k] - batched[k]));
+  }
+
+  cout << iterations << " time stamps, " << SENSORS << " sensors, " << FUSION_CHANNELS << " channels" << endl;
+  cout << "One call per channel: " << separate_s * 1e6 / iterations << " us per time stamp" << endl;
+  cout << "One batched call:     " << batched_s * 1e6 / iterations << " us per time stamp" << endl;
+  cout << "Speedup: " << separate_s / batched_s << "x, largest difference: " << max_diff << endl;
+  return 0;
+}
+
+#endif
@@ -0,0 +1,23 @@
+# Writes a synthetic topology with the given number of sensors, in fusions of 8,
+# reusing the input files of the inputs folder in turn. Used to check the
+# startup time and peak memory of large sites, e.g.
+#   ./generate_topology.sh 10000 > topology_10k.txt
+#   ulimit -n 16384; ./Testing_Algorithm_TOP topology_10k.txt
+if [ -z $1 ]
+then
+  echo "Please run the script with the number of sensors, e.g. ./generate_topology.sh 10000 > topology_10k.txt" >&2
+  exit 1
+fi
+sensors=$1
+echo "criterion 0.9"
+echo "budget_us 0"
+echo "horizon 00:01:00:000"
+awk -v sensors=$sensors 'BEGIN {
+  for(s = 0; s < sensors; s++) {
+    if(s % 8 == 0) {
+      printf "%sfusion Fusion%d", (s ? "\n" : ""), s / 8 + 1
+    }
+    printf " ./inputs/Temperature_Sensor_Values%d.txt", s % 8 + 1
+  }
+  printf "\n"
+}'
@@ -2,6 +2,12 @@
 #include <chrono>
 #include <algorithm>
 #include <string>
+#include <fstream>
+#include <sstream>
+
+#ifndef RT_ARM_MBED
+  #include <sys/resource.h>
+#endif
 
 #include <cadmium/modeling/coupling.hpp>
 #include <cadmium/modeling/ports.hpp>
@@ -16,19 +22,24 @@
 
 #include "../atomics/Fusion.hpp"
 #include "../atomics/Sensor.hpp"
+#include "topology.hpp"
 
 #include <NDTime.hpp>
 
-const char* t1_IN = "./inputs/Temperature_Sensor_Values1.txt";
-const char* t2_IN = "./inputs/Temperature_Sensor_Values2.txt";
-const char* t3_IN = "./inputs/Temperature_Sensor_Values3.txt";
-const char* t4_IN = "./inputs/Temperature_Sensor_Values4.txt";
-const char* t5_IN = "./inputs/Temperature_Sensor_Values5.txt";
-const char* t6_IN = "./inputs/Temperature_Sensor_Values6.txt";
-const char* t7_IN = "./inputs/Temperature_Sensor_Values7.txt";
-const char* t8_IN = "./inputs/Temperature_Sensor_Values8.txt";
-const char* t9_IN = "./inputs/Temperature_Sensor_Values9.txt";
-const char* t10_IN = "./inputs/Temperature_Sensor_Values10.txt";
+#ifdef RT_ARM_MBED
+  //There is no file system for a manifest on the board
+  const char* TOPOLOGY =
+    "criterion 0.9\n"
+    //Time allowed for one fusion on the board, Fusion degrades its mode when it is exceeded
+    "budget_us 100000\n"
+    "horizon 100:00:00:000\n"
+    "fusion Fusion1 ./inputs/Temperature_Sensor_Values1.txt ./inputs/Temperature_Sensor_Values2.txt"
+    " ./inputs/Temperature_Sensor_Values3.txt ./inputs/Temperature_Sensor_Values4.txt"
+    " ./inputs/Temperature_Sensor_Values5.txt ./inputs/Temperature_Sensor_Values6.txt"
+    " ./inputs/Temperature_Sensor_Values7.txt ./inputs/Temperature_Sensor_Values8.txt\n";
+#else
+  const char* TOPOLOGY_IN = "./topology.txt";
+#endif
 
 using namespace std;
 
@@ -71,57 +82,28 @@ int main(int argc, char ** argv) {
   using log_all=cadmium::logger::multilogger<info, debug, state, log_messages, routing, global_time, local_time>;
   using logger_top=cadmium::logger::multilogger<log_messages, global_time>;
 
-  using AtomicModelPtr=std::shared_ptr<cadmium::dynamic::modeling::model>;
   using CoupledModelPtr=std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>;
 
-  AtomicModelPtr Sensor1 = cadmium::dynamic::translate::make_dynamic_atomic_model<Sensor, TIME>("Sensor1", t1_IN);
-  AtomicModelPtr Sensor2 = cadmium::dynamic::translate::make_dynamic_atomic_model<Sensor, TIME>("Sensor2", t2_IN);
-  AtomicModelPtr Sensor3 = cadmium::dynamic::translate::make_dynamic_atomic_model<Sensor, TIME>("Sensor3", t3_IN);
-  AtomicModelPtr Sensor4 = cadmium::dynamic::translate::make_dynamic_atomic_model<Sensor, TIME>("Sensor4", t4_IN);
-  AtomicModelPtr Sensor5 = cadmium::dynamic::translate::make_dynamic_atomic_model<Sensor, TIME>("Sensor5", t5_IN);
-  AtomicModelPtr Sensor6 = cadmium::dynamic::translate::make_dynamic_atomic_model<Sensor, TIME>("Sensor6", t6_IN);
-  AtomicModelPtr Sensor7 = cadmium::dynamic::translate::make_dynamic_atomic_model<Sensor, TIME>("Sensor7", t7_IN);
-  AtomicModelPtr Sensor8 = cadmium::dynamic::translate::make_dynamic_atomic_model<Sensor, TIME>("Sensor8", t8_IN);
-  AtomicModelPtr Sensor9 = cadmium::dynamic::translate::make_dynamic_atomic_model<Sensor, TIME>("Sensor9", t9_IN);
-  
-  AtomicModelPtr Fusion1 = cadmium::dynamic::translate::make_dynamic_atomic_model<Fusion, TIME>("Fusion1");
-  
-  cadmium::dynamic::modeling::Ports iports_TOP = {};
-  cadmium::dynamic::modeling::Ports oports_TOP = {};
-
-  cadmium::dynamic::modeling::Models submodels_TOP = {Sensor1, Sensor2, Sensor3, Sensor4, Sensor5, Sensor6, Sensor7, Sensor8, Fusion1};
-
-cadmium::dynamic::modeling::EICs eics_TOP = {};
-cadmium::dynamic::modeling::EOCs eocs_TOP = {};
-
-cadmium::dynamic::modeling::ICs ics_TOP = {
-cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s1T>("Sensor1","Fusion1"),
-
-  cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s2T>("Sensor2","Fusion1"),
-
-  cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s3T>("Sensor3","Fusion1"),
-
-  cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s4T>("Sensor4","Fusion1"),
+  /*************** Topology *******************/
 
-  cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s5T>("Sensor5","Fusion1"),
-
-  cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s6T>("Sensor6","Fusion1"),
-
-  cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s7T>("Sensor7","Fusion1"),
-
-  cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s8T>("Sensor8","Fusion1")
+  topology_manifest manifest;
+  std::string error;
+  #ifdef RT_ARM_MBED
+    std::istringstream topology_in(TOPOLOGY);
+  #else
+    std::ifstream topology_in(argc > 1 ? argv[1] : TOPOLOGY_IN);
+    if(!topology_in) {
+      cerr << "Cannot open " << (argc > 1 ? argv[1] : TOPOLOGY_IN) << endl;
+      return 1;
+    }
+  #endif
+  if(!parse_topology(topology_in, manifest, error)) {
+    cerr << "Invalid topology, " << error << endl;
+    return 1;
+  }
 
+  CoupledModelPtr TOP = build_topology<TIME>(manifest);
 
-};
-CoupledModelPtr TOP = std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
-    "TOP",
-    submodels_TOP,
-    iports_TOP,
-    oports_TOP,
-    eics_TOP,
-    eocs_TOP,
-    ics_TOP
-    );
 #ifdef RT_ARM_MBED
    // cadmium::dynamic::engine::runner<NDTime, logger_top> r(TOP, {0});
 
@@ -132,7 +114,21 @@ CoupledModelPtr TOP = std::make_shared<cadmium::dynamic::modeling::coupled<TIME>
     cadmium::dynamic::engine::runner<NDTime, logger_top> r(TOP, {0});
 #endif
 
-r.run_until(NDTime("100:00:00:000"));
+#ifndef RT_ARM_MBED
+  //Startup is everything before the first simulation step, including opening every sensor file
+  auto startup = chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  #ifdef __APPLE__
+    long peak_kib = usage.ru_maxrss / 1024;
+  #else
+    long peak_kib = usage.ru_maxrss;
+  #endif
+  cout << "Topology: " << manifest.sensor_files.size() << " sensors, " << manifest.groups.size() << " fusions" << endl;
+  cout << "Startup: " << startup << " seconds, peak memory: " << peak_kib << " KiB" << endl;
+#endif
+
+r.run_until(NDTime(manifest.horizon.c_str()));
 #ifndef RT_ARM_MBED
 return 0;
 #endif
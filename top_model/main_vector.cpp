@@ -0,0 +1,112 @@
+// Top model of the multi-quantity sensors: eight SensorVector models feeding
+// one FusionVector model that fuses every channel in one pass.
+// Host only, the board runs the top model of main.cpp.
+#ifndef RT_ARM_MBED
+
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <fstream>
+
+#include <cadmium/modeling/coupling.hpp>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/concept/coupled_model_assert.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/tuple_to_ostream.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include <cadmium/io/iestream.hpp>
+
+#include "../atomics/FusionVector.hpp"
+#include "../atomics/SensorVector.hpp"
+
+#include <NDTime.hpp>
+
+const char* m1_IN = "./inputs/multi_sensor/Multi_Sensor_Values1.txt";
+const char* m2_IN = "./inputs/multi_sensor/Multi_Sensor_Values2.txt";
+const char* m3_IN = "./inputs/multi_sensor/Multi_Sensor_Values3.txt";
+const char* m4_IN = "./inputs/multi_sensor/Multi_Sensor_Values4.txt";
+const char* m5_IN = "./inputs/multi_sensor/Multi_Sensor_Values5.txt";
+const char* m6_IN = "./inputs/multi_sensor/Multi_Sensor_Values6.txt";
+const char* m7_IN = "./inputs/multi_sensor/Multi_Sensor_Values7.txt";
+const char* m8_IN = "./inputs/multi_sensor/Multi_Sensor_Values8.txt";
+
+//A sensor faulty on one quantity is removed from all of them
+const bool SHARE_FAULTS = true;
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+int main(int argc, char ** argv) {
+
+  auto start = hclock::now(); //to measure simulation execution time
+
+  /*************** Loggers *******************/
+
+  static std::ofstream out_data("SensorFusion_Vector_output.txt");
+  struct oss_sink_provider{
+    static std::ostream& sink(){
+      return out_data;
+    }
+  };
+
+  using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages, cadmium::dynamic::logger::formatter<TIME>, oss_sink_provider>;
+  using global_time=cadmium::logger::logger<cadmium::logger::logger_global_time, cadmium::dynamic::logger::formatter<TIME>, oss_sink_provider>;
+  using logger_top=cadmium::logger::multilogger<log_messages, global_time>;
+
+  using AtomicModelPtr=std::shared_ptr<cadmium::dynamic::modeling::model>;
+  using CoupledModelPtr=std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>;
+
+  AtomicModelPtr Sensor1 = cadmium::dynamic::translate::make_dynamic_atomic_model<SensorVector, TIME>("Sensor1", m1_IN);
+  AtomicModelPtr Sensor2 = cadmium::dynamic::translate::make_dynamic_atomic_model<SensorVector, TIME>("Sensor2", m2_IN);
+  AtomicModelPtr Sensor3 = cadmium::dynamic::translate::make_dynamic_atomic_model<SensorVector, TIME>("Sensor3", m3_IN);
+  AtomicModelPtr Sensor4 = cadmium::dynamic::translate::make_dynamic_atomic_model<SensorVector, TIME>("Sensor4", m4_IN);
+  AtomicModelPtr Sensor5 = cadmium::dynamic::translate::make_dynamic_atomic_model<SensorVector, TIME>("Sensor5", m5_IN);
+  AtomicModelPtr Sensor6 = cadmium::dynamic::translate::make_dynamic_atomic_model<SensorVector, TIME>("Sensor6", m6_IN);
+  AtomicModelPtr Sensor7 = cadmium::dynamic::translate::make_dynamic_atomic_model<SensorVector, TIME>("Sensor7", m7_IN);
+  AtomicModelPtr Sensor8 = cadmium::dynamic::translate::make_dynamic_atomic_model<SensorVector, TIME>("Sensor8", m8_IN);
+
+  AtomicModelPtr Fusion1 = cadmium::dynamic::translate::make_dynamic_atomic_model<FusionVector, TIME>("Fusion1", 0.9, SHARE_FAULTS);
+
+  cadmium::dynamic::modeling::Ports iports_TOP = {};
+  cadmium::dynamic::modeling::Ports oports_TOP = {};
+
+  cadmium::dynamic::modeling::Models submodels_TOP = {Sensor1, Sensor2, Sensor3, Sensor4, Sensor5, Sensor6, Sensor7, Sensor8, Fusion1};
+
+  cadmium::dynamic::modeling::EICs eics_TOP = {};
+  cadmium::dynamic::modeling::EOCs eocs_TOP = {};
+
+  cadmium::dynamic::modeling::ICs ics_TOP = {
+    cadmium::dynamic::translate::make_IC<SensorVector_defs::out, FusionVector_defs::s1T>("Sensor1","Fusion1"),
+    cadmium::dynamic::translate::make_IC<SensorVector_defs::out, FusionVector_defs::s2T>("Sensor2","Fusion1"),
+    cadmium::dynamic::translate::make_IC<SensorVector_defs::out, FusionVector_defs::s3T>("Sensor3","Fusion1"),
+    cadmium::dynamic::translate::make_IC<SensorVector_defs::out, FusionVector_defs::s4T>("Sensor4","Fusion1"),
+    cadmium::dynamic::translate::make_IC<SensorVector_defs::out, FusionVector_defs::s5T>("Sensor5","Fusion1"),
+    cadmium::dynamic::translate::make_IC<SensorVector_defs::out, FusionVector_defs::s6T>("Sensor6","Fusion1"),
+    cadmium::dynamic::translate::make_IC<SensorVector_defs::out, FusionVector_defs::s7T>("Sensor7","Fusion1"),
+    cadmium::dynamic::translate::make_IC<SensorVector_defs::out, FusionVector_defs::s8T>("Sensor8","Fusion1")
+  };
+  CoupledModelPtr TOP = std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+      "TOP",
+      submodels_TOP,
+      iports_TOP,
+      oports_TOP,
+      eics_TOP,
+      eocs_TOP,
+      ics_TOP
+      );
+
+  cadmium::dynamic::engine::runner<NDTime, logger_top> r(TOP, {0});
+  r.run_until(NDTime("100:00:00:000"));
+
+  auto elapsed = chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+  cout << "Simulation took: " << elapsed << " seconds" << endl;
+  return 0;
+}
+
+#endif
@@ -0,0 +1,245 @@
+// Host real-time mode: one producer thread per sensor replays its trace at
+// wall-clock rate (or scaled) into a lock-free queue, a fusion thread merges
+// the queues on the trace time stamps and fuses every time stamp, in groups of
+// 8 sensors by default like the Fusion model, and publishes the fused values
+// through a lock-free ring, and the main thread measures the end-to-end
+// latency of every published value.
+#ifndef RT_ARM_MBED
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include "../drivers/Algorithm.h"
+#include "../drivers/Stream.h"
+#include "../drivers/SpscQueue.hpp"
+
+using namespace std;
+
+using sclock=chrono::steady_clock;
+
+const size_t SAMPLE_QUEUE_SIZE = 1024;
+const size_t RESULT_RING_SIZE = 4096;
+
+struct reading {
+  long long ms;                   // time stamp in the trace
+  double value;
+  sclock::time_point acquired;
+};
+
+struct fused_value {
+  long long ms;                   // time stamp or start of the time slot
+  int group;
+  double fused;
+  sclock::time_point acquired;    // oldest reading that went into the fusion
+};
+
+struct sensor_channel {
+  const char* path;
+  spsc_queue<reading, SAMPLE_QUEUE_SIZE> queue;
+  atomic<bool> finished{false};   // set once the last reading is pushed
+  atomic<unsigned long> dropped{0};
+};
+
+// Stand-in for a sensor driver thread: replays a trace, never blocks on the queue.
+static void acquire(sensor_channel* ch, sclock::time_point epoch, double scale) {
+  stream_reader* reader = stream_reader_open(ch->path, 4096);
+  long long ms;
+  double value;
+
+  if(reader == nullptr) {
+    cerr << "Cannot open " << ch->path << endl;
+  }
+  while(reader != nullptr && stream_reader_next(reader, &ms, &value)) {
+    if(scale > 0) {
+      this_thread::sleep_until(epoch + chrono::microseconds((long long) (ms * 1000 / scale)));
+    }
+    if(!ch->queue.push(reading{ms, value, sclock::now()})) {
+      ch->dropped.fetch_add(1, memory_order_relaxed);
+    }
+  }
+  stream_reader_close(reader);
+  ch->finished.store(true, memory_order_release);
+}
+
+/*
+ * Merges the queues on the trace time stamps as stream_aligner_fill merges
+ * the files: every time stamp, or every time slot with a tick, is fused once
+ * with the latest reading of every sensor. A time stamp is only fused once
+ * every sensor still replaying has delivered a reading at it or later, so a
+ * sensor sampling slower than the others holds the fusion back until its
+ * next reading.
+ */
+static void fuse(vector<unique_ptr<sensor_channel>>* channels, spsc_queue<fused_value, RESULT_RING_SIZE>* ring,
+                 double criterion, int group_size, long long tick_ms, atomic<bool>* done, atomic<unsigned long>* dropped) {
+  const int sensors = (int) channels->size();
+  const int groups = (sensors + group_size - 1) / group_size;
+  vector<double> latest(sensors, 0.0);
+  vector<reading> next(sensors);
+  vector<char> pending(sensors, 0), ended(sensors, 0);
+
+  // The buffers of every group are allocated once, the loop below does not allocate
+  vector<fusion_workspace*> workspaces(groups);
+  for(int g = 0; g < groups; g++) {
+    workspaces[g] = fusion_workspace_alloc(min(group_size, sensors - g * group_size), 1);
+  }
+
+  for(;;) {
+    bool waiting = false, found = false;
+    long long t = 0;
+
+    for(int i = 0; i < sensors; i++) {
+      sensor_channel& ch = *(*channels)[i];
+      if(!pending[i] && !ended[i]) {
+        // Read the flag before popping so that no reading pushed before the end is missed
+        bool finished = ch.finished.load(memory_order_acquire);
+        if(ch.queue.pop(next[i])) {
+          pending[i] = 1;
+        } else if(finished) {
+          ended[i] = 1;
+        } else {
+          waiting = true;
+        }
+      }
+      if(pending[i] && (!found || next[i].ms < t)) {
+        t = next[i].ms;
+        found = true;
+      }
+    }
+
+    if(waiting) {
+      this_thread::yield();
+      continue;
+    }
+    if(!found) {
+      break;
+    }
+
+    long long limit = t + 1;
+    if(tick_ms > 0) {
+      t -= ((t % tick_ms) + tick_ms) % tick_ms;
+      limit = t + tick_ms;
+    }
+    sclock::time_point oldest = sclock::time_point::max();
+    for(int i = 0; i < sensors; i++) {
+      if(pending[i] && next[i].ms < limit) {
+        latest[i] = next[i].value;
+        oldest = min(oldest, next[i].acquired);
+        pending[i] = 0;
+      }
+    }
+
+    for(int g = 0; g < groups; g++) {
+      fused_value r{t, g, 0, oldest};
+      sensor_fusion_workspace(workspaces[g], &latest[g * group_size], criterion, 0, &r.fused);
+      if(!ring->push(r)) {
+        dropped->fetch_add(1, memory_order_relaxed);
+      }
+    }
+  }
+
+  for(fusion_workspace* ws : workspaces) {
+    fusion_workspace_free(ws);
+  }
+  done->store(true, memory_order_release);
+}
+
+// Nearest-rank percentile: the smallest value with at least p of the values at or below it
+static double percentile(vector<double>& v, double p) {
+  if(v.empty()) {
+    return 0;
+  }
+  double rank = ceil(p * v.size());
+  size_t k = rank < 1 ? 0 : min(v.size() - 1, (size_t) rank - 1);
+  nth_element(v.begin(), v.begin() + k, v.end());
+  return v[k];
+}
+
+int main(int argc, char ** argv) {
+  double scale = 1;
+  double criterion = 0.9;
+  int group_size = 8;
+  long long tick_ms = 0;
+  vector<unique_ptr<sensor_channel>> channels;
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-s") && i + 1 < argc) {
+      scale = atof(argv[++i]);
+    } else if(!strcmp(argv[i], "-c") && i + 1 < argc) {
+      criterion = atof(argv[++i]);
+    } else if(!strcmp(argv[i], "-g") && i + 1 < argc) {
+      group_size = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-t") && i + 1 < argc) {
+      tick_ms = atoll(argv[++i]);
+    } else {
+      channels.emplace_back(new sensor_channel());
+      channels.back()->path = argv[i];
+    }
+  }
+  if(channels.empty() || group_size <= 0 || tick_ms < 0) {
+    cerr << "Usage: " << argv[0] << " [-s scale] [-c criterion] [-g group_size] [-t tick_ms] sensor_file..." << endl;
+    cerr << "  -s 1 replays at wall-clock rate, -s 60 one minute per second, -s 0 as fast as possible" << endl;
+    return 1;
+  }
+
+  spsc_queue<fused_value, RESULT_RING_SIZE> ring;
+  atomic<bool> done(false);
+  atomic<unsigned long> results_dropped(0);
+  vector<double> latencies_us;
+  latencies_us.reserve(1 << 20);
+
+  sclock::time_point epoch = sclock::now();
+  thread fusion_thread(fuse, &channels, &ring, criterion, group_size, tick_ms, &done, &results_dropped);
+  vector<thread> acquisition;
+  for(auto &ch : channels) {
+    acquisition.emplace_back(acquire, ch.get(), epoch, scale);
+  }
+
+  // Consumer of the fused values
+  fused_value r;
+  size_t timestamps = 0;
+  for(;;) {
+    bool finished = done.load(memory_order_acquire);
+    if(ring.pop(r)) {
+      if(r.group == 0) {
+        timestamps++;
+      }
+      latencies_us.push_back(chrono::duration<double, micro>(sclock::now() - r.acquired).count());
+    } else if(finished) {
+      break;
+    } else {
+      this_thread::yield();
+    }
+  }
+
+  for(auto &t : acquisition) {
+    t.join();
+  }
+  fusion_thread.join();
+
+  unsigned long samples_dropped = 0;
+  for(auto &ch : channels) {
+    samples_dropped += ch->dropped.load();
+  }
+  size_t fused = latencies_us.size();
+  double p50 = percentile(latencies_us, 0.5);
+  double p99 = percentile(latencies_us, 0.99);
+  double p999 = percentile(latencies_us, 0.999);
+  double worst = latencies_us.empty() ? 0 : *max_element(latencies_us.begin(), latencies_us.end());
+
+  cout << "Fused values: " << fused << " at " << timestamps << " time stamps from " << channels.size() << " sensors" << endl;
+  cout << "Dropped samples: " << samples_dropped << " dropped results: " << results_dropped.load() << endl;
+  cout << "End-to-end latency (us) p50: " << p50 << " p99: " << p99 << " p99.9: " << p999
+       << " max: " << worst << endl;
+  return 0;
+}
+
+#endif
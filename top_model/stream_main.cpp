@@ -0,0 +1,140 @@
+// Streaming reprocessing of sensor archives larger than the memory.
+// Host only: the sensor files are fused batch by batch without the Cadmium
+// engine, in groups of 8 sensors by default like the Fusion model, and every
+// group gets its own column in the output file (see ../drivers/Stream.c).
+#ifndef RT_ARM_MBED
+
+#include <iostream>
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "../drivers/Algorithm.h"
+#include "../drivers/Stream.h"
+
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+
+const char* STREAM_OUT = "SensorFusion_Stream_output.sfc";
+
+struct batch {
+  vector<long long> timestamps;
+  vector<double> values;
+  vector<double> fused;
+  int rows;
+};
+
+static void usage(const char* name) {
+  cerr << "Usage: " << name << " [-o output] [-b rows] [-k block_kib] [-c criterion] [-g group_size] [-t tick_ms] sensor_file..." << endl;
+}
+
+int main(int argc, char ** argv) {
+  const char* out_path = STREAM_OUT;
+  int batch_rows = 4096;
+  size_t block_size = 64 * 1024;
+  double criterion = 0.9;
+  int group_size = 8;
+  long long tick_ms = 0;
+  vector<const char*> paths;
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-o") && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if(!strcmp(argv[i], "-b") && i + 1 < argc) {
+      batch_rows = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-k") && i + 1 < argc) {
+      block_size = (size_t) atol(argv[++i]) * 1024;
+    } else if(!strcmp(argv[i], "-c") && i + 1 < argc) {
+      criterion = atof(argv[++i]);
+    } else if(!strcmp(argv[i], "-g") && i + 1 < argc) {
+      group_size = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-t") && i + 1 < argc) {
+      tick_ms = atoll(argv[++i]);
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if(paths.empty() || batch_rows <= 0 || block_size == 0 || group_size <= 0 || tick_ms < 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  auto start = hclock::now();
+  const int sensors = (int) paths.size();
+  // Consecutive files form a group, the last group may be smaller
+  const int groups = (sensors + group_size - 1) / group_size;
+
+  stream_aligner* aligner = stream_aligner_open(paths.data(), sensors, block_size, tick_ms);
+  if(aligner == nullptr) {
+    cerr << "Cannot open the sensor files" << endl;
+    return 1;
+  }
+  stream_writer* writer = stream_writer_open(out_path, sensors, groups);
+  if(writer == nullptr) {
+    cerr << "Cannot create " << out_path << endl;
+    stream_aligner_close(aligner);
+    return 1;
+  }
+
+  // The buffers of every group are allocated once for the whole run
+  vector<fusion_workspace*> workspaces(groups);
+  for(int g = 0; g < groups; g++) {
+    workspaces[g] = fusion_workspace_alloc(min(group_size, sensors - g * group_size), 1);
+  }
+
+  // Two batches: the next one is read and aligned while the current one is fused
+  batch slots[2];
+  for(auto &b : slots) {
+    b.timestamps.resize(batch_rows);
+    b.values.resize((size_t) batch_rows * sensors);
+    b.fused.resize((size_t) batch_rows * groups);
+    b.rows = 0;
+  }
+  auto prefetch = [&](batch* b) {
+    b->rows = stream_aligner_fill(aligner, b->timestamps.data(), b->values.data(), batch_rows);
+    return b->rows;
+  };
+
+  long long total_rows = 0;
+  bool ok = true;
+  int current = 0;
+  future<int> pending = async(launch::async, prefetch, &slots[current]);
+
+  while(pending.get() > 0) {
+    batch &b = slots[current];
+    current ^= 1;
+    pending = async(launch::async, prefetch, &slots[current]);
+
+    // One decomposition per group and row, the fused values are stored column after column
+    for(int r = 0; r < b.rows; r++) {
+      for(int g = 0; g < groups; g++) {
+        sensor_fusion_workspace(workspaces[g], &b.values[(size_t) r * sensors + g * group_size], criterion, 0,
+                                &b.fused[(size_t) g * b.rows + r]);
+      }
+    }
+    ok = stream_writer_append(writer, b.timestamps.data(), b.fused.data(), b.rows) && ok;
+    total_rows += b.rows;
+  }
+
+  for(fusion_workspace* ws : workspaces) {
+    fusion_workspace_free(ws);
+  }
+  stream_aligner_close(aligner);
+  ok = stream_writer_close(writer) && ok;
+
+  auto elapsed = chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+  cout << "Fused " << total_rows << " time stamps of " << sensors << " sensors in " << groups << " groups into " << out_path
+       << " in " << elapsed << " seconds" << endl;
+  if(!ok) {
+    cerr << "Error while writing " << out_path << endl;
+    return 1;
+  }
+  return 0;
+}
+
+#endif
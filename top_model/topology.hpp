@@ -0,0 +1,234 @@
+#ifndef BOOST_SIMULATION_TOPOLOGY_HPP
+#define BOOST_SIMULATION_TOPOLOGY_HPP
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <unordered_set>
+#include <ctype.h>
+
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+
+#include "../atomics/Fusion.hpp"
+#include "../atomics/Sensor.hpp"
+
+using namespace std;
+
+/*
+ * Topology manifest, one statement per line, '#' starts a comment:
+ *
+ *   criterion 0.9                  criterion of every Fusion model
+ *   budget_us 0                    time allowed for one fusion, 0 disables the deadline monitor
+ *   horizon 100:00:00:000          simulated time to run until, hh:mm:ss or hh:mm:ss:mss
+ *   fusion Fusion1 file1 ... file8 one Fusion model fed by 1 to 8 sensor files
+ *
+ * Sensors are named Sensor1, Sensor2, ... in the order of their files and
+ * every fusion is placed in a coupled model named after it with "_group"
+ * appended, so fusion names must be unique and must not look like sensor
+ * names. A Fusion model with fewer than 8 sensors fuses only those sensors.
+ * On the host every sensor file must exist, a sensor without input would
+ * never send anything.
+ */
+
+const int FUSION_PORTS = 8;
+
+struct fusion_group {
+  string name;
+  int first_sensor;   // index of its first file in topology_manifest::sensor_files
+  int sensors;
+};
+
+struct topology_manifest {
+  double criterion = 0.9;
+  long budget_us = 0;
+  string horizon = "100:00:00:000";
+  vector<string> sensor_files;
+  vector<fusion_group> groups;
+};
+
+// Checks that a time has the hh:mm:ss or hh:mm:ss:mss format NDTime reads
+inline bool valid_topology_time(const string& time) {
+  int fields = 0;
+  size_t start = 0;
+  for(;;) {
+    size_t end = time.find(':', start);
+    string field = time.substr(start, end == string::npos ? string::npos : end - start);
+    if(field.empty() || field.size() > 9) {
+      return false;
+    }
+    for(char c : field) {
+      if(!isdigit((unsigned char) c)) {
+        return false;
+      }
+    }
+    long value = stol(field);
+    if((fields == 1 || fields == 2) && value >= 60) {
+      return false;
+    }
+    if(fields == 3 && value >= 1000) {
+      return false;
+    }
+    fields++;
+    if(end == string::npos) {
+      break;
+    }
+    start = end + 1;
+  }
+  return fields == 3 || fields == 4;
+}
+
+// True for the names given to the sensors, Sensor followed by digits only
+inline bool is_sensor_name(const string& name) {
+  if(name.compare(0, 6, "Sensor") != 0 || name.size() == 6) {
+    return false;
+  }
+  for(size_t k = 6; k < name.size(); k++) {
+    if(!isdigit((unsigned char) name[k])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline bool parse_topology(istream& in, topology_manifest& manifest, string& error) {
+  string line, key;
+  int number = 0;
+  unordered_set<string> names;
+
+  while(getline(in, line)) {
+    number++;
+    size_t comment = line.find('#');
+    if(comment != string::npos) {
+      line.erase(comment);
+    }
+    istringstream words(line);
+    if(!(words >> key)) {
+      continue;
+    }
+
+    bool ok = true;
+    if(key == "criterion") {
+      ok = (bool) (words >> manifest.criterion);
+    } else if(key == "budget_us") {
+      ok = (bool) (words >> manifest.budget_us);
+    } else if(key == "horizon") {
+      ok = (bool) (words >> manifest.horizon);
+      if(ok && !valid_topology_time(manifest.horizon)) {
+        error = "line " + to_string(number) + ": invalid horizon '" + manifest.horizon + "'";
+        return false;
+      }
+    } else if(key == "fusion") {
+      fusion_group group;
+      group.first_sensor = (int) manifest.sensor_files.size();
+      ok = (bool) (words >> group.name);
+      if(ok && (is_sensor_name(group.name) || group.name == "TOP"
+          || !names.insert(group.name).second || !names.insert(group.name + "_group").second)) {
+        error = "line " + to_string(number) + ": fusion name '" + group.name + "' is already used or reserved";
+        return false;
+      }
+      string file;
+      while(ok && words >> file) {
+        #ifndef RT_ARM_MBED
+          if(!ifstream(file)) {
+            error = "line " + to_string(number) + ": cannot open sensor file '" + file + "'";
+            return false;
+          }
+        #endif
+        manifest.sensor_files.push_back(std::move(file));
+      }
+      group.sensors = (int) manifest.sensor_files.size() - group.first_sensor;
+      ok = ok && group.sensors >= 1 && group.sensors <= FUSION_PORTS;
+      if(ok) {
+        manifest.groups.push_back(std::move(group));
+      }
+    } else {
+      ok = false;
+    }
+
+    if(!ok) {
+      error = "line " + to_string(number) + ": cannot read '" + line + "'";
+      return false;
+    }
+  }
+  if(manifest.groups.empty()) {
+    error = "no fusion in the topology";
+    return false;
+  }
+  return true;
+}
+
+// Couples the sensor to input port s1T + port of the Fusion model
+inline cadmium::dynamic::modeling::ICs::value_type make_sensor_IC(int port, const string& sensor, const string& fusion) {
+  switch(port) {
+    case 0: return cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s1T>(sensor, fusion);
+    case 1: return cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s2T>(sensor, fusion);
+    case 2: return cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s3T>(sensor, fusion);
+    case 3: return cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s4T>(sensor, fusion);
+    case 4: return cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s5T>(sensor, fusion);
+    case 5: return cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s6T>(sensor, fusion);
+    case 6: return cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s7T>(sensor, fusion);
+    default: return cadmium::dynamic::translate::make_IC<Sensor_defs::out, Fusion_defs::s8T>(sensor, fusion);
+  }
+}
+
+/*
+ * Every fusion group becomes its own coupled model holding its sensors and
+ * Fusion model, and TOP only holds the groups. The couplings of a group are
+ * resolved among its 9 models at most instead of among every model of the
+ * site, so the construction time grows linearly with the number of sensors.
+ * All containers are sized up front and the model pointers are moved, never
+ * copied.
+ */
+template<typename TIME>
+shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> build_topology(const topology_manifest& manifest) {
+  using CoupledModel=cadmium::dynamic::modeling::coupled<TIME>;
+
+  cadmium::dynamic::modeling::Models submodels_TOP;
+  submodels_TOP.reserve(manifest.groups.size());
+  string sensor;
+
+  for(const fusion_group& group : manifest.groups) {
+    cadmium::dynamic::modeling::Models submodels;
+    cadmium::dynamic::modeling::ICs ics;
+    submodels.reserve(group.sensors + 1);
+    ics.reserve(group.sensors);
+
+    for(int port = 0; port < group.sensors; port++) {
+      const int index = group.first_sensor + port;
+      sensor = "Sensor" + to_string(index + 1);
+      submodels.push_back(cadmium::dynamic::translate::make_dynamic_atomic_model<Sensor, TIME>(
+          sensor, manifest.sensor_files[index].c_str()));
+      ics.push_back(make_sensor_IC(port, sensor, group.name));
+    }
+    submodels.push_back(cadmium::dynamic::translate::make_dynamic_atomic_model<Fusion, TIME>(
+        group.name, manifest.criterion, manifest.budget_us, group.sensors));
+
+    submodels_TOP.push_back(make_shared<CoupledModel>(
+        group.name + "_group",
+        std::move(submodels),
+        cadmium::dynamic::modeling::Ports{},
+        cadmium::dynamic::modeling::Ports{},
+        cadmium::dynamic::modeling::EICs{},
+        cadmium::dynamic::modeling::EOCs{},
+        std::move(ics)
+        ));
+  }
+
+  return make_shared<CoupledModel>(
+      "TOP",
+      std::move(submodels_TOP),
+      cadmium::dynamic::modeling::Ports{},
+      cadmium::dynamic::modeling::Ports{},
+      cadmium::dynamic::modeling::EICs{},
+      cadmium::dynamic::modeling::EOCs{},
+      cadmium::dynamic::modeling::ICs{}
+      );
+}
+
+#endif